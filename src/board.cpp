@@ -8,15 +8,11 @@
 
 #include "board.h"
 
-// Initializes board and define neighborhood.
-Board::Board(int n, int m, int c, bool all_neighbors) : n(n), m(m), c(c) {
-  board_map = matrix<int>(n, std::vector<int>(m));
-  group_map = matrix<int>(n, std::vector<int>(m));
-
-  next_moves = std::vector<int>(c + 1);
-  frontier = std::vector<std::queue<int>>(c + 1, std::queue<int>());
+const int Board::MAX_COLORS;
 
-  turn = 1;
+// Initializes board and define neighborhood.
+Board::Board(int n, int m, int c, bool all_neighbors) {
+  resize(n, m, c);
 
   // if all_neighbors is true, then the diagonals are included
   if (all_neighbors) {
@@ -30,17 +26,63 @@ Board::Board(int n, int m, int c, bool all_neighbors) : n(n), m(m), c(c) {
   }
 }
 
+// Changes board size and number of colors, reusing allocated memory.
+void Board::resize(int n, int m, int c) {
+  this->n = n;
+  this->m = m;
+  this->c = c;
+
+  board_map.resize(n * m);
+  group_map.assign(n * m, 0);
+
+  next_moves.resize(c + 1);
+  next_depth.resize(c + 1);
+  gain.resize(c + 1);
+  frontier.resize(c + 1);
+
+  turn = 1;
+}
+
 // Associates graph built by Builder to board (the graph is a different
 // representation, other than a matrix, to the same board).
 void Board::set_graph(Graph graph) {
-  this->graph = graph;
+
+  // Moved (not copied) so memory of a previous, larger graph is freed
+  this->graph = std::move(graph);
+  this->graph.compute_depths();
+
+  stamp = std::vector<int>(this->graph.size(), 0);
+  cur_stamp = 0;
+}
+
+// Plays a movement for good, contracting the flooded region in the graph
+// so later searches run on a smaller graph.
+void Board::commit_move(int color) {
+  graph.contract(color);
+  graph.compute_depths();
+
+  stamp.assign(graph.size(), 0);
+  cur_stamp = 0;
+}
+
+// Gets number of groups left (flooded region counts as one).
+int Board::num_groups() {
+  return graph.size();
 }
 
 // Reads only the board itself (matrix of colors).
-void Board::read_input() {
-  for (auto &i : board_map)
-    for (auto &j : i)
-      std::cin >> j;
+bool Board::read_input(std::istream &in) {
+
+  // Checked before being stored, larger colors would wrap around in a byte
+  int color;
+  for (auto &i : board_map) {
+    if (!(in >> color) or color < 1 or color > c)
+      return false;
+
+    i = color;
+  }
+
+  return true;
 }
 
 // Resets board's internal state.
@@ -48,22 +90,25 @@ void Board::reset() {
 
   // next_moves[i] contains area yielded by color i
   std::fill(next_moves.begin(), next_moves.end(), 0);
+  std::fill(next_depth.begin(), next_depth.end(), 0);
 
-  // Swap turn from 1 to 2 or 2 to 1, it is used as a marker to avoid exploring
-  // vertices that were already explored in this turn
-  turn = 3 - turn;
+  // Increment turn, it is used as a marker to avoid exploring vertices that
+  // were already explored in this turn (swapping between two values is not
+  // enough when a rollout is interrupted, e.g. by a new search)
+  turn++;
 
   // Empty frontier
   for (auto &i : frontier)
-    while (!i.empty())
-      i.pop();
+    i.clear();
 
   // Fill frontier based on upper-left group
   graph[0].marker = turn;
   for (auto i : graph[0]) {
     graph[i].marker = turn;
-    frontier[graph[i].color].push(i);
+    frontier[graph[i].color].push_back(i);
     next_moves[graph[i].color] += graph[i].area;
+    next_depth[graph[i].color] = std::max(next_depth[graph[i].color],
+        graph[i].depth);
   }
 }
 
@@ -77,23 +122,33 @@ std::vector<tuple2> Board::get_first_actions() {
     if (frontier[i].size())
       actions.push_back(tuple2(next_moves[i], i));
 
+  // Sorted by yielded area, like the actions given by apply_color
+  std::sort(actions.begin(), actions.end());
+
   return actions;
 }
 
-// Allows board[i] to return board_map[i] (better readability).
-std::vector<int> & Board::operator[](int i) {
-  return board_map[i];
+// Allows board[i][j] to return the color of tile (i, j) (better
+// readability).
+uint8_t * Board::operator[](int i) {
+  return &board_map[i * m];
+}
+
+// Frees tile matrices (board_map and group_map), after the graph is built
+// only the graph is used.
+void Board::release_tiles() {
+  std::vector<uint8_t>().swap(board_map);
+  std::vector<uint32_t>().swap(group_map);
 }
 
 // Applies a movement (color) and returns every possible movement i where
 // i.second is the movement itself (color) and i.first is the area that the
 // movement yields.
-std::vector<tuple2> Board::apply_color(int color) {
+const std::vector<tuple2> &Board::apply_color(int color) {
 
-  // Apply BFS step to frontier color only
-  while (!frontier[color].empty()) {
-    int v = frontier[color].front();
-    frontier[color].pop();
+  // Apply BFS step to frontier color only; neighbors of a vertex never have
+  // its color, so frontier[color] does not grow while it is expanded
+  for (auto v : frontier[color]) {
 
     // Update next_moves[v.color] to remove expanded group
     next_moves[graph[v].color] -= graph[v].area;
@@ -103,16 +158,21 @@ std::vector<tuple2> Board::apply_color(int color) {
         graph[i].marker = turn;
 
         // Add neighbors to the correspoding queue based on their colors
-        frontier[graph[i].color].push(i);
+        frontier[graph[i].color].push_back(i);
 
         // Update next_moves to contain area yielded by neighbors
         next_moves[graph[i].color] += graph[i].area;
+        next_depth[graph[i].color] = std::max(next_depth[graph[i].color],
+            graph[i].depth);
       }
   }
 
+  frontier[color].clear();
+  next_depth[color] = 0;
+
   // Build sorted vector of movements by the yielded area to be used in
   // the rollout phase
-  std::vector<tuple2> next;
+  next.clear();
   for (int i = 1; i <= c; ++i)
     if (next_moves[i] > 0)
       next.push_back(tuple2(next_moves[i], i));
@@ -121,3 +181,28 @@ std::vector<tuple2> Board::apply_color(int color) {
 
   return next;
 }
+
+// Computes area yielded by a movement followed by the best second movement,
+// without applying it.
+int Board::lookahead(int color) {
+  for (int i = 1; i <= c; ++i)
+    gain[i] = next_moves[i];
+  gain[color] = 0;
+
+  // Stamps avoid counting twice vertices adjacent to several absorbed ones
+  cur_stamp++;
+
+  for (auto v : frontier[color])
+    for (auto i : graph[v])
+      if (graph[i].marker != turn and stamp[i] != cur_stamp) {
+        stamp[i] = cur_stamp;
+        gain[graph[i].color] += graph[i].area;
+      }
+
+  return next_moves[color] + *std::max_element(gain.begin(), gain.end());
+}
+
+// Gets greatest depth (distance from the corner) reached by a movement.
+int Board::reach(int color) {
+  return next_depth[color];
+}
@@ -9,8 +9,9 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <utility>
 #include <iostream>
-#include <queue>
 #include <algorithm>
 
 #include "types.h"
@@ -24,15 +25,31 @@ private:
   bool first_move;
 
   std::vector<int> next_moves;
+
+  // Greatest depth of the frontier vertices of each color
+  std::vector<int> next_depth;
+
+  // Buffers reused by apply_color and lookahead (no allocations during
+  // rollouts)
+  std::vector<tuple2> next;
+  std::vector<int> gain, stamp;
+  int cur_stamp;
   const std::vector<int> full_dx = {0, 1,  0, -1, 1,  1, -1, -1};
   const std::vector<int> full_dy = {1, 0, -1,  0, 1, -1, -1,  1};
 
 public:
+  // Largest number of colors (tiles are stored in a byte)
+  static const int MAX_COLORS = 255;
+
   int n, m, c;
 
   std::vector<int> dx, dy;
-  std::vector<std::queue<int>> frontier;
-  matrix<int> group_map, board_map;
+  std::vector<std::vector<int>> frontier;
+
+  // Tiles stored row by row in flat vectors (colors fit in a byte), only
+  // needed until the graph is built
+  std::vector<uint8_t> board_map;
+  std::vector<uint32_t> group_map;
 
   /**
    * Initializes board and define neighborhood.
@@ -43,6 +60,15 @@ public:
    */
   Board(int n, int m, int c, bool all_neighbors);
 
+  /**
+   * Changes board size and number of colors, reusing allocated memory (used
+   * when the same board object solves several puzzles).
+   *
+   * @param (n, m) size of the board.
+   * @param c number of colors
+   */
+  void resize(int n, int m, int c);
+
   /**
    * Associates graph built by Builder to board (the graph is a different
    * representation, other than a matrix, to the same board).
@@ -52,10 +78,28 @@ public:
    */
   void set_graph(Graph graph);
 
+  /**
+   * Plays a movement for good, contracting the flooded region in the graph
+   * so later searches run on a smaller graph.
+   *
+   * @param color movement (color) to be played.
+   */
+  void commit_move(int color);
+
+  /**
+   * Gets number of groups left (flooded region counts as one).
+   *
+   * @return number of vertices in the graph.
+   */
+  int num_groups();
+
   /**
    * Reads only the board itself (matrix of colors).
+   *
+   * @param in stream where the board is read from.
+   * @return whether every tile was read and is a color between 1 and c.
    */
-  void read_input();
+  bool read_input(std::istream &in = std::cin);
 
   /**
    * Resets board's internal state.
@@ -72,12 +116,19 @@ public:
   std::vector<tuple2> get_first_actions();
 
   /**
-   * Allows board[i] to return board_map[i] (better readability).
+   * Allows board[i][j] to return the color of tile (i, j) (better
+   * readability).
    *
-   * @param i index of board_map.
-   * @return board_map[i].
+   * @param i row of the board.
+   * @return pointer to the first tile of the i-th row.
    */
-  std::vector<int> &operator[](int i);
+  uint8_t *operator[](int i);
+
+  /**
+   * Frees tile matrices (board_map and group_map), after the graph is built
+   * only the graph is used.
+   */
+  void release_tiles();
 
   /**
    * Applies a movement (color) and returns every possible movement i where
@@ -91,7 +142,25 @@ public:
    *
    * @param color movement (color) to be applied to the board.
    * @return available actions (colors) after move was made, where first is the
-   * area that the color yields and second is the color itself.
+   * area that the color yields and second is the color itself (valid until
+   * the next call).
+   */
+  const std::vector<tuple2> &apply_color(int color);
+
+  /**
+   * Computes area yielded by a movement followed by the best second movement,
+   * without applying it.
+   *
+   * @param color movement (color) to be evaluated.
+   * @return area yielded by the two movements.
+   */
+  int lookahead(int color);
+
+  /**
+   * Gets greatest depth (distance from the corner) reached by a movement.
+   *
+   * @param color movement (color) to be evaluated.
+   * @return depth of the farthest vertex absorbed by the movement.
    */
-  std::vector<tuple2> apply_color(int color);
+  int reach(int color);
 };
@@ -8,75 +8,231 @@
 
 #include "builder.h"
 
+// Minimum number of tiles of a strip, smaller ones are not worth a thread
+static const int MIN_STRIP_AREA = 1 << 16;
+
 // Initializes builder.
-Builder::Builder(Board *board) : board(board) {
-  num_groups = 1;
-}
+Builder::Builder(Board *board, bool release_tiles, int num_threads) :
+    board(board), release_tiles(release_tiles), num_threads(num_threads) {}
+
+// Goes through every tile in a group inside a strip (iteratively, large
+// boards would overflow the stack), marking them with a label in group_map
+// and appending them to tiles.
+int Builder::get_group(int x, int y, int color, uint32_t label, strip &s) {
+  int m = board->m;
+
+  // Tiles appended to 'tiles' but not expanded yet work as the stack
+  size_t next = s.tiles.size();
+  board->group_map[x * m + y] = label;
+  s.tiles.push_back(x * m + y);
+
+  while (next < s.tiles.size()) {
+    int cx = s.tiles[next] / m, cy = s.tiles[next] % m;
+    next++;
+
+    for (uint it = 0; it < board->dx.size(); ++it) {
+      int i = cx + board->dx[it], j = cy + board->dy[it];
+
+      // Check if it is inside the strip and belongs to this group
+      if (i >= s.begin and i < s.end and j >= 0 and j < m and
+          !board->group_map[i * m + j] and (*board)[i][j] == color) {
+        board->group_map[i * m + j] = label;
+        s.tiles.push_back(i * m + j);
+      }
+    }
+  }
 
-// Recusively goes through every tile in a group, while populating the vector
-// group with the coordinates of the found tiles and neighbors set with the
-// coordinates of the group's border tiles (neighbor tiles).
-int Builder::get_group(int x, int y, int color) {
+  // Return area of the group
+  return s.tiles.size() - s.start.back();
+}
 
-  // Mark group map with the group's id in the corresponding cell
-  board->group_map[x][y] = num_groups;
-  groups.push_back(tuple2(x, y));
+// Splits strip in components (groups restricted to the strip's rows).
+void Builder::label_strip(strip &s) {
+  int m = board->m;
+
+  s.tiles.clear();
+  s.tiles.reserve((s.end - s.begin) * m);
+  s.start.assign(1, 0);
+
+  // Look for tiles that don't belong to any component yet, labels are local
+  // to the strip (starting at 1) until every strip is done
+  for (int i = s.begin; i < s.end; ++i)
+    for (int j = 0; j < m; ++j)
+      if (!board->group_map[i * m + j]) {
+        get_group(i, j, (*board)[i][j], s.start.size(), s);
+        s.start.push_back(s.tiles.size());
+      }
+}
 
-  int ans = 0;
-  for (uint it = 0; it < board->dx.size(); ++it) {
-    int i = board->dx[it], j = board->dy[it];
+// Finds root of a component in the union-find.
+uint32_t Builder::find(uint32_t v) {
+  while (parent[v] != v) {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
 
-    // Check if it is inside the board
-    if (x + i >= 0 and x + i < board->n and y + j >= 0 and y + j < board->m) {
+  return v;
+}
 
-      // Check if it belongs to this group, if yes, follows recursively
-      if (!board->group_map[x + i][y + j] and (*board)[x + i][y + j] == color)
-        ans += get_group(x + i, y + j, color) + 1;
+// Merges components of adjacent tiles of the same color across the seam
+// between a strip and the strip above it.
+void Builder::merge_seam(int i) {
+  int m = board->m, x = strips[i].begin;
+
+  for (int y = 0; y < m; ++y) {
+    for (uint it = 0; it < board->dx.size(); ++it) {
+      int j = y + board->dy[it];
+
+      // Only neighbors in the row above the seam
+      if (board->dx[it] != -1 or j < 0 or j >= m or
+          (*board)[x - 1][j] != (*board)[x][y])
+        continue;
+
+      uint32_t a = find(strips[i].offset + board->group_map[x * m + y] - 1);
+      uint32_t b = find(strips[i - 1].offset +
+          board->group_map[(x - 1) * m + j] - 1);
+
+      // Smallest id is kept as root, so it is the group's first component
+      if (a < b)
+        parent[b] = a;
+      else
+        parent[a] = b;
+    }
+  }
+}
 
-      // If it's out of the group then it's a neighbor
-      else if ((*board)[x + i][y + j] != color)
-        neighbors.insert(tuple2(x + i, y + j));
+// Gets ids of groups adjacent to a range of tiles of the same group, sorted
+// and without repetitions.
+void Builder::get_neighbors(const uint32_t *begin, const uint32_t *end,
+    std::vector<int> &adj) {
+  int n = board->n, m = board->m;
+  adj.clear();
+
+  for (const uint32_t *k = begin; k != end; ++k) {
+    int x = *k / m, y = *k % m;
+    uint32_t group = board->group_map[*k];
+
+    for (uint it = 0; it < board->dx.size(); ++it) {
+      int i = x + board->dx[it], j = y + board->dy[it];
+
+      // Tiles of other groups are neighbors (adjacent tiles of the same color
+      // always belong to the same group)
+      if (i >= 0 and i < n and j >= 0 and j < m) {
+        uint32_t other = board->group_map[i * m + j];
+        if (other != group)
+          adj.push_back(other - 1);
+      }
     }
   }
 
-  // Return area computed so far
-  return ans;
+  std::sort(adj.begin(), adj.end());
+  adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
 }
 
 // Builds graph where each vertex is a group of tiles of the same color
 // in the initial board.
 Graph Builder::build_graph() {
   Graph graph;
+  int n = board->n, m = board->m;
+
+  // Split board in strips of rows, one per thread
+  int num_strips = std::max(1, std::min({num_threads, n,
+        int(uint64_t(n) * m / MIN_STRIP_AREA)}));
 
-  // Look for tiles that don't belong to any groups yet
-  for (int i = 0; i < board->n; ++i) {
-    for (int j = 0; j < board->m; ++j) {
-      if (!board->group_map[i][j]) {
-        groups.clear();
-        neighbors.clear();
+  strips.resize(num_strips);
+  for (int i = 0; i < num_strips; ++i) {
+    strips[i].begin = uint64_t(n) * i / num_strips;
+    strips[i].end = uint64_t(n) * (i + 1) / num_strips;
+  }
+
+  parallel(num_strips, [this](int i) { label_strip(strips[i]); });
 
-        // Fill group and neighbors with the group data starting on (i,j)
-        int area = get_group(i, j, (*board)[i][j]) + 1;
+  // Give every component a global id (strip's offset + local label - 1)
+  uint32_t num_comps = 0;
+  for (auto &i : strips) {
+    i.offset = num_comps;
+    num_comps += i.start.size() - 1;
+  }
 
-        graph.add_vertex(vertex(num_groups - 1, (*board)[i][j], area));
-        nmap[num_groups++] = neighbors;
+  parent.resize(num_comps);
+  for (uint32_t i = 0; i < num_comps; ++i)
+    parent[i] = i;
+
+  for (int i = 1; i < num_strips; ++i)
+    merge_seam(i);
+
+  // Groups are numbered by their first tile, like a serial row by row scan.
+  // Components are ordered the same way (strips by rows, components of a
+  // strip by their first tile), and a group's root is its smallest component
+  std::vector<uint32_t> group(num_comps);
+  for (auto &s : strips) {
+    for (uint32_t k = 0; k + 1 < s.start.size(); ++k) {
+      uint32_t i = s.offset + k, root = find(i);
+      int area = s.start[k + 1] - s.start[k];
+
+      if (root == i) {
+        group[i] = graph.size();
+        graph.add_vertex(vertex(group[i], board->board_map[s.tiles[s.start[k]]],
+              area));
+      } else {
+        group[i] = group[root];
+        graph[group[i]].area += area;
       }
     }
   }
 
-  // Build graph
-  for (int i = 1; i <= num_groups; ++i) {
-    std::set<int> adj;
+  // Relabel tiles with their group's id (+1, 0 means no group)
+  parallel(num_strips, [this, &group](int i) {
+    strip &s = strips[i];
+    for (uint32_t k = 0; k + 1 < s.start.size(); ++k)
+      for (uint32_t t = s.start[k]; t < s.start[k + 1]; ++t)
+        board->group_map[s.tiles[t]] = group[s.offset + k] + 1;
+  });
+
+  // Build adjacency lists, components of groups split by seams are kept apart
+  // to be merged later
+  std::vector<std::vector<int>> adj(num_comps);
+  parallel(num_strips, [this, &adj, &group, &graph](int i) {
+    strip &s = strips[i];
+    std::vector<int> nb;
+
+    for (uint32_t k = 0; k + 1 < s.start.size(); ++k) {
+      uint32_t c = s.offset + k;
+      get_neighbors(&s.tiles[s.start[k]], &s.tiles[s.start[k + 1]], nb);
+
+      if (parent[c] == c)
+        graph[group[c]].neighbors.assign(nb.begin(), nb.end());
+      else
+        adj[c].assign(nb.begin(), nb.end());
+    }
+  });
+
+  // Merge adjacency lists of groups split by seams
+  std::vector<bool> split(graph.size(), false);
+  for (uint32_t i = 0; i < num_comps; ++i)
+    if (parent[i] != i) {
+      std::vector<int> &nb = graph[group[i]].neighbors;
+      nb.insert(nb.end(), adj[i].begin(), adj[i].end());
+      split[group[i]] = true;
+    }
 
-    // Get ids from neighbors
-    for (auto j : nmap[i])
-      adj.insert(board->group_map[j.first][j.second]);
+  for (int i = 0; i < graph.size(); ++i)
+    if (split[i]) {
+      std::vector<int> &nb = graph[i].neighbors;
+      std::sort(nb.begin(), nb.end());
+      nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+    }
 
-    // Add them to the i-th's adjacency list
-    for (auto j : adj)
-      graph[i - 1].add_neighbor(j - 1);
-  }
+  // Only the graph is needed from now on
+  if (release_tiles)
+    release();
 
-  nmap.clear();
   return graph;
 }
+
+// Frees the board's tiles and the builder's buffers.
+void Builder::release() {
+  std::vector<strip>().swap(strips);
+  std::vector<uint32_t>().swap(parent);
+  board->release_tiles();
+}
@@ -8,9 +8,10 @@
 
 #pragma once
 
-#include <map>
-#include <set>
 #include <vector>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
 
 #include "types.h"
 #include "board.h"
@@ -20,37 +21,120 @@ class Builder {
 
 private:
   Board *board;
-  int num_groups;
+  bool release_tiles;
+  int num_threads;
 
-  std::vector<tuple2> groups;
-  std::set<tuple2> neighbors;
-  std::map<int, std::set<tuple2>> nmap;
+  /**
+   * Strip of consecutive rows, labeled independently from the others.
+   */
+  struct strip {
+    int begin, end;
+
+    // Id of the strip's first component among the components of every strip
+    uint32_t offset;
+
+    // Tiles (index i * m + j) ordered by component, the tiles of a component
+    // are contiguous since they are found by a single flood fill
+    std::vector<uint32_t> tiles;
+    std::vector<uint32_t> start;
+  };
+
+  std::vector<strip> strips;
+
+  // Union-find of components, used to merge the ones split by strip seams
+  std::vector<uint32_t> parent;
 
   /**
-   * Recusively goes through every tile in a group, while populating the vector
-   * 'group' with the coordinates of the found tiles and 'neighbors' set with
-   * the coordinates of the group's border tiles (neighbor tiles).
+   * Goes through every tile in a group inside a strip (iteratively, large
+   * boards would overflow the stack), marking them with a label in group_map
+   * and appending them to 'tiles'.
    *
-   * @param (x, y) coordinates of tile in the current group.
+   * @param (x, y) coordinates of a tile in the group.
    * @param color color of every tile in the group.
-   * @return area of group (i.e. number of tiles).
+   * @param label label given to the group's tiles.
+   * @param s strip being labeled.
+   * @return area of group inside the strip (i.e. number of tiles).
+   */
+  int get_group(int x, int y, int color, uint32_t label, strip &s);
+
+  /**
+   * Splits strip in components (groups restricted to the strip's rows).
+   *
+   * @param s strip to be labeled.
+   */
+  void label_strip(strip &s);
+
+  /**
+   * Merges components of adjacent tiles of the same color across the seam
+   * between a strip and the strip above it.
+   *
+   * @param i index of the strip below the seam.
    */
-  int get_group(int x, int y, int color);
+  void merge_seam(int i);
+
+  /**
+   * Finds root of a component in the union-find.
+   *
+   * @param v component.
+   * @return root of the component's set.
+   */
+  uint32_t find(uint32_t v);
+
+  /**
+   * Gets ids of groups adjacent to a range of tiles of the same group, sorted
+   * and without repetitions.
+   *
+   * @param (begin, end) range of tiles.
+   * @param adj filled with the ids of the neighbor groups.
+   */
+  void get_neighbors(const uint32_t *begin, const uint32_t *end,
+      std::vector<int> &adj);
+
+  /**
+   * Calls f(i) for every i in [0, num), each call in its own thread.
+   *
+   * @param num number of calls.
+   * @param f function to be called.
+   */
+  template <class F>
+  void parallel(int num, F f) {
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num; ++i)
+      threads.push_back(std::thread(f, i));
+
+    f(0);
+    for (auto &i : threads)
+      i.join();
+  }
 
 public:
   /**
    * Initializes builder.
    *
    * @param board board being used.
+   * @param release_tiles whether the board's tiles (and builder's buffers)
+   * are freed after the graph is built (boards reused for several puzzles may
+   * want to keep them).
+   * @param num_threads maximum number of threads used to build the graph.
    */
-  Builder(Board *board);
+  Builder(Board *board, bool release_tiles = true, int num_threads = 1);
 
   /**
    * Builds graph where each vertex is a group of tiles of the same color
    * in the initial board.
    *
+   * The board is split in strips of rows labeled in parallel; groups crossing
+   * strips are merged afterwards, so the graph is the same regardless of the
+   * number of threads.
+   *
    * @return the graph where each vertex is a group of adjacent tiles of
    * the same color in the board.
    */
   Graph build_graph();
+
+  /**
+   * Frees the board's tiles and the builder's buffers (done by build_graph
+   * when release_tiles is set), they are allocated again by the next build.
+   */
+  void release();
 };
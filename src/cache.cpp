@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#include "cache.h"
+
+// Initializes cache and loads previously stored solutions.
+Cache::Cache(std::string path) : path(path) {
+  has_last = false;
+  load();
+}
+
+// Loads every entry from the cache file, keeping the shortest solution
+// found for each key.
+void Cache::load() {
+  std::ifstream file(path);
+  std::string line;
+
+  // Each line is: key n m c size moves...
+  while (std::getline(file, line)) {
+    std::istringstream in(line);
+
+    uint64_t key;
+    int size;
+    entry e;
+
+    if (!(in >> std::hex >> key >> std::dec >> e.n >> e.m >> e.c >> size))
+      continue;
+
+    // Skip corrupted lines, a solution never needs more movements than the
+    // board has tiles
+    if (e.n <= 0 or e.m <= 0 or e.c <= 0 or size < 0 or
+        size > int64_t(e.n) * e.m)
+      continue;
+
+    e.solution.resize(size);
+    for (auto &i : e.solution)
+      in >> i;
+
+    // Skip truncated lines (e.g. process killed while writing)
+    if (!in or !valid_moves(e.solution, e.c))
+      continue;
+
+    auto it = entries.find(key);
+    if (it == entries.end() or e.solution.size() < it->second.solution.size())
+      entries[key] = e;
+
+    last_key = key;
+    has_last = true;
+  }
+}
+
+// Checks whether every movement is a color between 1 and c.
+bool Cache::valid_moves(const std::vector<int> &moves, int c) {
+  for (auto i : moves)
+    if (i < 1 or i > c)
+      return false;
+
+  return true;
+}
+
+// Looks for a solution of exactly the same board.
+bool Cache::find(uint64_t key, Graph *graph, int c,
+    std::vector<int> &solution) {
+  auto it = entries.find(key);
+  if (it == entries.end() or !valid_moves(it->second.solution, c))
+    return false;
+
+  // The file may be shared by several processes, so a hash collision or an
+  // interleaved line could give a wrong solution; replay it to be sure
+  Flood flood(graph, c);
+  for (auto i : it->second.solution)
+    flood.apply(i);
+
+  // Forget it, so the solution found by the search replaces it
+  if (!flood.done()) {
+    entries.erase(it);
+    return false;
+  }
+
+  solution = it->second.solution;
+  return true;
+}
+
+// Looks for a solution of a board with the same dimensions and number of
+// colors, to be used as a starting point (not necessarily valid) for a
+// new search.
+bool Cache::find_similar(int n, int m, int c, std::vector<int> &solution) {
+
+  // Prefer the most recent entry, since boards tend to come in batches
+  auto it = has_last ? entries.find(last_key) : entries.end();
+  if (it != entries.end()) {
+    entry &e = it->second;
+    if (e.n == n and e.m == m and e.c == c) {
+      solution = e.solution;
+      return true;
+    }
+  }
+
+  for (auto &i : entries)
+    if (i.second.n == n and i.second.m == m and i.second.c == c) {
+      solution = i.second.solution;
+      return true;
+    }
+
+  return false;
+}
+
+// Stores solution if it is better than the known one and appends it to the
+// cache file.
+void Cache::insert(uint64_t key, int n, int m, int c,
+    const std::vector<int> &solution) {
+  auto it = entries.find(key);
+  if (it != entries.end() and it->second.solution.size() <= solution.size())
+    return;
+
+  entries[key] = entry{n, m, c, solution};
+  last_key = key;
+  has_last = true;
+
+  // Append only, so the file is never rewritten and older entries are simply
+  // shadowed by shorter ones when loading
+  std::ofstream file(path, std::ios::app);
+  file << std::hex << key << std::dec << " " << n << " " << m << " " << c
+       << " " << solution.size();
+
+  for (auto i : solution)
+    file << " " << i;
+  file << std::endl;
+}
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "types.h"
+#include "graph.h"
+#include "flood.h"
+
+/**
+ * Cached solution along with the board dimensions it was found for.
+ */
+struct entry {
+  int n, m, c;
+  std::vector<int> solution;
+};
+
+
+class Cache {
+
+private:
+  std::string path;
+  std::unordered_map<uint64_t, entry> entries;
+
+  // Key of the most recently stored entry, used for warm starts
+  uint64_t last_key;
+  bool has_last;
+
+  /**
+   * Loads every entry from the cache file, keeping the shortest solution
+   * found for each key.
+   */
+  void load();
+
+  /**
+   * Checks whether every movement is a color between 1 and c.
+   *
+   * @param moves sequence of movements.
+   * @param c number of colors.
+   * @return whether the movements are valid colors.
+   */
+  bool valid_moves(const std::vector<int> &moves, int c);
+
+public:
+  /**
+   * Initializes cache and loads previously stored solutions.
+   *
+   * @param path file where solutions are persisted.
+   */
+  Cache(std::string path);
+
+  /**
+   * Looks for a solution of exactly the same board. The solution is replayed
+   * on the graph before being returned, so only valid solutions are found.
+   *
+   * @param key hash of the board's graph.
+   * @param graph graph of the board.
+   * @param c number of colors.
+   * @param solution filled with the cached solution, if found.
+   * @return whether the board was found.
+   */
+  bool find(uint64_t key, Graph *graph, int c, std::vector<int> &solution);
+
+  /**
+   * Looks for a solution of a board with the same dimensions and number of
+   * colors, to be used as a starting point (not necessarily valid) for a
+   * new search.
+   *
+   * @param (n, m) size of the board.
+   * @param c number of colors.
+   * @param solution filled with the cached solution, if found.
+   * @return whether a similar board was found.
+   */
+  bool find_similar(int n, int m, int c, std::vector<int> &solution);
+
+  /**
+   * Stores solution if it is better than the known one and appends it to the
+   * cache file.
+   *
+   * @param key hash of the board's graph.
+   * @param (n, m) size of the board.
+   * @param c number of colors.
+   * @param solution sequence of movements that solves the board.
+   */
+  void insert(uint64_t key, int n, int m, int c,
+      const std::vector<int> &solution);
+};
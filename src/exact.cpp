@@ -0,0 +1,249 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#include "exact.h"
+
+// Maximum number of entries of each worker's transposition table
+static const int TABLE_SIZE = 1 << 20;
+
+// Entries of the transposition table per vertex of the graph
+static const int TABLE_PER_VERTEX = 512;
+
+const int Exact::MAX_GROUPS;
+const int Exact::NODES_PER_ITERATION;
+
+// Initializes exact solver without a graph.
+Exact::Exact(int num_threads) : graph(nullptr), c(0),
+    num_threads(std::max(1, num_threads)), num_workers(0), table_size(0),
+    has_deadline(false) {}
+
+// Initializes exact solver.
+Exact::Exact(Graph *graph, int c, int num_threads) : Exact(num_threads) {
+  set_graph(graph, c);
+}
+
+// Associates a graph to the solver, reusing allocated memory.
+void Exact::set_graph(Graph *graph, int c) {
+  this->graph = graph;
+  this->c = c;
+
+  // Only first movements (colors adjacent to the corner group) are split
+  // among threads, more threads than that would be idle
+  std::vector<bool> first(c + 1, false);
+  for (auto v : (*graph)[0])
+    first[(*graph)[v].color] = true;
+
+  num_workers = std::max(1, std::min(num_threads,
+        int(std::count(first.begin(), first.end(), true))));
+
+  table_size = 1 << 12;
+  while (table_size < TABLE_SIZE and
+      table_size < int64_t(graph->size()) * TABLE_PER_VERTEX)
+    table_size <<= 1;
+
+  // Entries of a previous graph are cleared, its hashes may collide with the
+  // ones of the new graph
+  workers.resize(num_workers);
+  for (auto &w : workers) {
+    w.flood.set_graph(graph, c);
+    w.table.assign(table_size, entry{0, -1, 0});
+    w.dist.assign(graph->size(), 0);
+    w.order.resize(graph->size() + 1);
+  }
+}
+
+// Sets time limit.
+void Exact::set_deadline(clk::time_point deadline) {
+  this->deadline = deadline;
+  has_deadline = true;
+}
+
+// Removes time limit.
+void Exact::clear_deadline() {
+  has_deadline = false;
+}
+
+// Computes a lower bound on the number of movements left.
+int Exact::heuristic(worker &w, int limit) {
+  Flood &flood = w.flood;
+
+  if (flood.colors_left() > limit)
+    return flood.colors_left();
+
+  // Distance from the flooded region to the farthest vertex (BFS starting
+  // from the frontier); dist is 0 for vertices not reached yet
+  w.queue.clear();
+  for (int i = 1; i <= c; ++i)
+    for (auto v : flood.get_frontier(i)) {
+      w.dist[v] = 1;
+      w.queue.push_back(v);
+    }
+
+  int far = 0;
+  for (size_t k = 0; k < w.queue.size(); ++k) {
+    int v = w.queue[k];
+    far = w.dist[v];
+
+    // Already above the limit, no need to know how far exactly
+    if (far > limit)
+      break;
+
+    for (auto u : (*graph)[v])
+      if (!w.dist[u] and !flood.flooded(u)) {
+        w.dist[u] = w.dist[v] + 1;
+        w.queue.push_back(u);
+      }
+  }
+
+  for (auto v : w.queue)
+    w.dist[v] = 0;
+
+  return std::max(far, flood.colors_left());
+}
+
+// Depth-first search limited by bound (f = depth + heuristic).
+int Exact::search(worker &w, int depth, int bound) {
+  Flood &flood = w.flood;
+
+  if (found or stop or w.exhausted)
+    return INT_MAX;
+
+  if (flood.done()) {
+    std::lock_guard<std::mutex> lock(solution_mutex);
+    if (!found) {
+      solution = w.path;
+      found = true;
+    }
+    return INT_MAX;
+  }
+
+  if (++w.nodes > w.max_nodes) {
+    w.exhausted = true;
+    return INT_MAX;
+  }
+
+  // Check deadline every few nodes only, clock is not free
+  if (has_deadline and w.nodes % 1024 == 0 and clk::now() >= deadline) {
+    stop = true;
+    return INT_MAX;
+  }
+
+  int f = depth + heuristic(w, bound - depth);
+  if (f > bound)
+    return f;
+
+  // Same state already reached in this iteration with fewer movements, its
+  // subtree was already searched with a larger budget
+  entry &e = w.table[flood.hash() & (table_size - 1)];
+  if (e.key == flood.hash() and e.bound == bound and e.depth <= depth)
+    return INT_MAX;
+  e = entry{flood.hash(), bound, depth};
+
+  // A movement that eliminates a color can always be played first in an
+  // optimal solution, no need to branch
+  int forced = 0;
+  for (int i = 1; i <= c and !forced; ++i)
+    if (flood.eliminates(i))
+      forced = i;
+
+  // Try first the movements that absorb more vertices
+  std::vector<tuple2> &order = w.order[depth];
+  order.clear();
+
+  if (forced)
+    order.push_back(tuple2(0, forced));
+  else
+    for (int i = 1; i <= c; ++i)
+      if (flood.available(i))
+        order.push_back(tuple2(-int(flood.get_frontier(i).size()), i));
+
+  std::sort(order.begin(), order.end());
+
+  int next = INT_MAX;
+  for (auto i : order) {
+    int color = i.second;
+    flood.apply(color);
+    w.path.push_back(color);
+
+    next = std::min(next, search(w, depth + 1, bound));
+
+    w.path.pop_back();
+    flood.undo();
+
+    if (found or stop or w.exhausted)
+      break;
+  }
+
+  return next;
+}
+
+// Looks for an optimal solution.
+bool Exact::run(int64_t max_nodes, std::vector<int> &result) {
+  found = stop = false;
+
+  std::vector<int> first;
+  for (int i = 1; i <= c; ++i)
+    if (workers[0].flood.available(i))
+      first.push_back(i);
+
+  if (first.empty()) {
+    result.clear();
+    return true;
+  }
+
+  for (auto &w : workers) {
+    w.nodes = 0;
+    w.max_nodes = max_nodes;
+    w.exhausted = false;
+  }
+
+  int bound = heuristic(workers[0], INT_MAX);
+  while (true) {
+    std::vector<int> next(num_workers, INT_MAX);
+
+    // First movements are split among threads, each one with its own state
+    // and transposition table
+    auto work = [this, &first, &next, bound](int t) {
+      worker &w = workers[t];
+
+      for (size_t i = t; i < first.size(); i += num_workers) {
+        w.flood.apply(first[i]);
+        w.path.assign(1, first[i]);
+
+        next[t] = std::min(next[t], search(w, 1, bound));
+
+        w.flood.undo();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_workers; ++t)
+      threads.push_back(std::thread(work, t));
+
+    work(0);
+    for (auto &i : threads)
+      i.join();
+
+    if (found or stop)
+      break;
+
+    // A worker out of budget leaves its part of the iteration unfinished
+    bool exhausted = false;
+    for (auto &w : workers)
+      exhausted = exhausted or w.exhausted;
+
+    bound = *std::min_element(next.begin(), next.end());
+    if (exhausted or bound == INT_MAX)
+      break;
+  }
+
+  if (found)
+    result = solution;
+
+  return found;
+}
@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <climits>
+#include <cstdint>
+#include <algorithm>
+
+#include "types.h"
+#include "graph.h"
+#include "flood.h"
+
+/**
+ * Exact solver using IDA* (iterative deepening A*) over the graph. Only
+ * viable for small graphs, it gives up when its node budget is over.
+ */
+class Exact {
+
+public:
+  // Largest graph (in groups) worth trying an exact search
+  static const int MAX_GROUPS = 400;
+
+  // Nodes searched per Monte Carlo iteration the exact search replaces (a
+  // node costs about a quarter of an iteration, so the budget takes about as
+  // long as the Monte Carlo search)
+  static const int NODES_PER_ITERATION = 4;
+
+private:
+  Graph *graph;
+  int c, num_threads, num_workers;
+
+  // Number of entries of each worker's transposition table (power of two)
+  int table_size;
+
+  /**
+   * Transposition table entry: best depth in which a state was reached in
+   * the iteration with the given bound.
+   */
+  struct entry {
+    uint64_t key;
+    int bound, depth;
+  };
+
+  /**
+   * Everything a thread needs to search a part of the tree.
+   */
+  struct worker {
+    Flood flood;
+    std::vector<int> path;
+    std::vector<entry> table;
+
+    // BFS buffers used by the heuristic
+    std::vector<int> queue, dist;
+
+    // Nodes searched so far, the worker stops once max_nodes is reached
+    int64_t nodes, max_nodes;
+    bool exhausted;
+
+    // Movements of each depth, sorted by the number of absorbed vertices
+    std::vector<std::vector<tuple2>> order;
+
+    worker() : nodes(0), max_nodes(0), exhausted(false) {}
+  };
+
+  std::vector<worker> workers;
+
+  bool has_deadline;
+  clk::time_point deadline;
+  std::atomic<bool> found, stop;
+
+  std::mutex solution_mutex;
+  std::vector<int> solution;
+
+  /**
+   * Computes a lower bound on the number of movements left: every color left
+   * needs a movement, and each movement advances the flooded region by one
+   * vertex in every path.
+   *
+   * @param w worker whose state is evaluated.
+   * @param limit estimates above limit don't need to be exact (any value
+   * above limit is returned).
+   * @return admissible estimate of movements left.
+   */
+  int heuristic(worker &w, int limit);
+
+  /**
+   * Depth-first search limited by bound (f = depth + heuristic).
+   *
+   * @param w worker whose state is searched.
+   * @param depth number of movements applied so far.
+   * @param bound maximum f of the current iteration.
+   * @return smallest f that exceeded bound (INT_MAX if solution was found or
+   * search stopped).
+   */
+  int search(worker &w, int depth, int bound);
+
+public:
+  /**
+   * Initializes exact solver without a graph (set_graph must be called
+   * before it is used).
+   *
+   * @param num_threads maximum number of threads (first movements are split
+   * among them).
+   */
+  Exact(int num_threads = 1);
+
+  /**
+   * Initializes exact solver.
+   *
+   * @param graph graph of the board.
+   * @param c number of colors.
+   * @param num_threads maximum number of threads (first movements are split
+   * among them).
+   */
+  Exact(Graph *graph, int c, int num_threads = 1);
+
+  /**
+   * Associates a graph to the solver, reusing allocated memory (used when
+   * the same object solves several boards). Threads are capped by the
+   * number of first movements, and transposition tables are sized from the
+   * graph.
+   *
+   * @param graph graph of the board.
+   * @param c number of colors.
+   */
+  void set_graph(Graph *graph, int c);
+
+  /**
+   * Sets time limit, the search gives up when it is reached even if the node
+   * budget is not over (results then depend on the machine's speed).
+   *
+   * @param deadline moment the search must end.
+   */
+  void set_deadline(clk::time_point deadline);
+
+  /**
+   * Removes time limit.
+   */
+  void clear_deadline();
+
+  /**
+   * Looks for an optimal solution. The search gives up when a thread
+   * searches more than max_nodes nodes, so whether a solution is found does
+   * not depend on the machine's speed.
+   *
+   * @param max_nodes node budget of each thread.
+   * @param result filled with the optimal sequence of movements, if found.
+   * @return whether an optimal solution was found within the budget.
+   */
+  bool run(int64_t max_nodes, std::vector<int> &result);
+};
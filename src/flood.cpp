@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#include "flood.h"
+
+// Initializes flood state without a graph.
+Flood::Flood() : graph(nullptr) {}
+
+// Initializes flood state.
+Flood::Flood(Graph *graph, int c) {
+  set_graph(graph, c);
+}
+
+// Associates a graph to the state and resets it, reusing allocated memory.
+void Flood::set_graph(Graph *graph, int c) {
+  this->graph = graph;
+  frontier.resize(c + 1);
+
+  std::mt19937_64 rng(graph->size());
+  keys.resize(graph->size());
+  for (auto &i : keys)
+    i = rng();
+
+  reset();
+}
+
+// Resets state to the beginning of the game (only vertex 0 flooded).
+void Flood::reset() {
+  state.assign(graph->size(), 0);
+  for (auto &i : frontier)
+    i.clear();
+
+  trail.clear();
+  steps.clear();
+
+  state[0] = 2;
+  left = graph->size() - 1;
+  key = keys[0];
+
+  count.assign(frontier.size(), 0);
+  for (int i = 1; i < graph->size(); ++i)
+    count[(*graph)[i].color]++;
+
+  colors = 0;
+  for (auto i : count)
+    colors += (i > 0);
+
+  for (auto i : (*graph)[0]) {
+    state[i] = 1;
+    frontier[(*graph)[i].color].push_back(i);
+  }
+}
+
+// Applies a movement (color).
+int Flood::apply(int color) {
+  step s;
+  s.color = color;
+  s.absorbed = trail.size();
+
+  // Every frontier vertex of the color is absorbed; its neighbors can't have
+  // the same color, so frontier[color] ends up empty
+  trail.insert(trail.end(), frontier[color].begin(), frontier[color].end());
+  frontier[color].clear();
+  s.touched = trail.size();
+
+  for (int k = s.absorbed; k < s.touched; ++k) {
+    int v = trail[k];
+    state[v] = 2;
+    left--;
+    key ^= keys[v];
+
+    for (auto u : (*graph)[v])
+      if (state[u] == 0) {
+        state[u] = 1;
+        frontier[(*graph)[u].color].push_back(u);
+        trail.push_back(u);
+      }
+  }
+
+  count[color] -= s.touched - s.absorbed;
+  if (count[color] == 0 and s.touched > s.absorbed)
+    colors--;
+
+  steps.push_back(s);
+  return s.touched - s.absorbed;
+}
+
+// Undoes the last applied movement.
+void Flood::undo() {
+  step s = steps.back();
+  steps.pop_back();
+
+  // Newly reached vertices were the last ones pushed to their frontiers
+  for (int k = trail.size() - 1; k >= s.touched; --k) {
+    int u = trail[k];
+    state[u] = 0;
+    frontier[(*graph)[u].color].pop_back();
+  }
+
+  for (int k = s.absorbed; k < s.touched; ++k) {
+    state[trail[k]] = 1;
+    frontier[s.color].push_back(trail[k]);
+    left++;
+    key ^= keys[trail[k]];
+  }
+
+  if (count[s.color] == 0 and s.touched > s.absorbed)
+    colors++;
+  count[s.color] += s.touched - s.absorbed;
+
+  trail.resize(s.absorbed);
+}
+
+// Checks whether a color is adjacent to the flooded region.
+bool Flood::available(int color) {
+  return !frontier[color].empty();
+}
+
+// Checks whether the whole graph is flooded.
+bool Flood::done() {
+  return left == 0;
+}
+
+// Gets number of movements applied since the last reset.
+int Flood::num_moves() {
+  return steps.size();
+}
+
+// Checks whether a vertex is part of the flooded region.
+bool Flood::flooded(int v) {
+  return state[v] == 2;
+}
+
+// Gets vertices of a color adjacent to the flooded region.
+const std::vector<int> &Flood::get_frontier(int color) {
+  return frontier[color];
+}
+
+// Checks whether a movement absorbs every vertex left of its color.
+bool Flood::eliminates(int color) {
+  return count[color] > 0 and int(frontier[color].size()) == count[color];
+}
+
+// Gets number of colors that still have vertices not flooded.
+int Flood::colors_left() {
+  return colors;
+}
+
+// Gets hash of the flooded region (which defines the state of the game).
+uint64_t Flood::hash() {
+  return key;
+}
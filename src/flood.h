@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+#include "types.h"
+#include "graph.h"
+
+/**
+ * Lightweight state of a game over the graph, where movements can be undone.
+ * Unlike Board, it does not compute the available actions after each
+ * movement, which makes replaying sequences of movements cheap.
+ */
+class Flood {
+
+private:
+  Graph *graph;
+
+  // 0 = not reached, 1 = frontier (adjacent to flooded region), 2 = flooded
+  std::vector<char> state;
+  std::vector<std::vector<int>> frontier;
+
+  /**
+   * Movement applied, along with where its vertices are in the trail.
+   */
+  struct step {
+    int color, absorbed, touched;
+  };
+
+  // Absorbed and newly reached vertices of every movement, used by undo
+  std::vector<int> trail;
+  std::vector<step> steps;
+
+  // Vertices not flooded yet, in total and of each color
+  int left, colors;
+  std::vector<int> count;
+
+  // Zobrist hash of the flooded region (xor of the keys of its vertices)
+  uint64_t key;
+  std::vector<uint64_t> keys;
+
+public:
+  /**
+   * Initializes flood state without a graph (set_graph must be called before
+   * it is used).
+   */
+  Flood();
+
+  /**
+   * Initializes flood state.
+   *
+   * @param graph graph of the board.
+   * @param c number of colors.
+   */
+  Flood(Graph *graph, int c);
+
+  /**
+   * Associates a graph to the state and resets it, reusing allocated memory
+   * (used when the same object plays several boards).
+   *
+   * @param graph graph of the board.
+   * @param c number of colors.
+   */
+  void set_graph(Graph *graph, int c);
+
+  /**
+   * Resets state to the beginning of the game (only vertex 0 flooded).
+   */
+  void reset();
+
+  /**
+   * Applies a movement (color).
+   *
+   * @param color movement to be applied.
+   * @return number of vertices absorbed by the movement.
+   */
+  int apply(int color);
+
+  /**
+   * Undoes the last applied movement.
+   */
+  void undo();
+
+  /**
+   * Checks whether a color is adjacent to the flooded region.
+   *
+   * @param color color to be checked.
+   * @return whether applying color absorbs any vertex.
+   */
+  bool available(int color);
+
+  /**
+   * Checks whether the whole graph is flooded.
+   *
+   * @return whether the game is over.
+   */
+  bool done();
+
+  /**
+   * Gets number of movements applied since the last reset.
+   *
+   * @return number of movements.
+   */
+  int num_moves();
+
+  /**
+   * Checks whether a vertex is part of the flooded region.
+   *
+   * @param v vertex.
+   * @return whether v is flooded.
+   */
+  bool flooded(int v);
+
+  /**
+   * Gets vertices of a color adjacent to the flooded region.
+   *
+   * @param color color of the vertices.
+   * @return frontier vertices of the color.
+   */
+  const std::vector<int> &get_frontier(int color);
+
+  /**
+   * Checks whether a movement absorbs every vertex left of its color.
+   *
+   * @param color movement (color).
+   * @return whether the color disappears from the board.
+   */
+  bool eliminates(int color);
+
+  /**
+   * Gets number of colors that still have vertices not flooded.
+   *
+   * @return number of colors left.
+   */
+  int colors_left();
+
+  /**
+   * Gets hash of the flooded region (which defines the state of the game).
+   *
+   * @return 64-bit hash of the state.
+   */
+  uint64_t hash();
+};
@@ -28,3 +28,138 @@ void Graph::add_vertex(vertex v) {
 vertex & Graph::operator[](int i) {
   return vertices[i];
 }
+
+// Gets number of vertices in the graph.
+int Graph::size() {
+  return vertices.size();
+}
+
+// Computes a hash (FNV-1a) of the graph's structure (colors, areas and
+// adjacency lists), used to identify previously seen boards.
+uint64_t Graph::hash() {
+  uint64_t h = 14695981039346656037ULL;
+
+  auto mix = [&h](uint64_t x) {
+    for (int i = 0; i < 8; ++i) {
+      h ^= (x >> (8 * i)) & 0xff;
+      h *= 1099511628211ULL;
+    }
+  };
+
+  mix(vertices.size());
+  for (auto &v : vertices) {
+    mix(v.color);
+    mix(v.area);
+    mix(v.neighbors.size());
+
+    for (auto i : v.neighbors)
+      mix(i);
+  }
+
+  return h;
+}
+
+// Floods the first vertex (flooded region) with a color, contracting it
+// and its neighbors of that color into a single vertex.
+int Graph::contract(int color) {
+  int n = vertices.size();
+
+  // New id of every vertex, absorbed vertices become part of vertex 0
+  std::vector<int> id(n, 0);
+  std::vector<bool> absorbed(n, false);
+
+  vertex &root = vertices[0];
+  root.color = color;
+
+  int num_absorbed = 0;
+  for (auto i : root)
+    if (vertices[i].color == color) {
+      absorbed[i] = true;
+      num_absorbed++;
+    }
+
+  if (num_absorbed == 0)
+    return 0;
+
+  int next = 1;
+  for (int i = 1; i < n; ++i)
+    if (!absorbed[i])
+      id[i] = next++;
+
+  // Neighbors of the new region are the neighbors of the absorbed vertices
+  // and the region's old neighbors that were not absorbed
+  std::vector<int> adj;
+  for (auto i : root) {
+    if (!absorbed[i]) {
+      adj.push_back(id[i]);
+      continue;
+    }
+
+    root.area += vertices[i].area;
+    for (auto j : vertices[i])
+      if (j != 0 and !absorbed[j])
+        adj.push_back(id[j]);
+  }
+
+  std::sort(adj.begin(), adj.end());
+  adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+  root.neighbors.swap(adj);
+
+  // Renumber neighbors of the remaining vertices; ids keep their relative
+  // order, so only lists touching the region need to be sorted again
+  for (int i = 1; i < n; ++i) {
+    if (absorbed[i])
+      continue;
+
+    bool touches = false;
+    for (auto &j : vertices[i]) {
+      touches |= (id[j] == 0);
+      j = id[j];
+    }
+
+    if (touches) {
+      std::vector<int> &nb = vertices[i].neighbors;
+      std::sort(nb.begin(), nb.end());
+      nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+    }
+  }
+
+  // Compact vertices, markers are cleared since the graph changed
+  for (int i = 0; i < n; ++i) {
+    if (absorbed[i])
+      continue;
+
+    vertex &v = vertices[id[i]];
+    if (id[i] != i) {
+      v.color = vertices[i].color;
+      v.area = vertices[i].area;
+      v.neighbors.swap(vertices[i].neighbors);
+    }
+
+    v.id = id[i];
+    v.marker = 0;
+  }
+
+  vertices.erase(vertices.begin() + next, vertices.end());
+  return num_absorbed;
+}
+
+// Computes depth of every vertex (BFS distance from the first vertex).
+void Graph::compute_depths() {
+  std::vector<int> queue(1, 0);
+  std::vector<bool> seen(vertices.size(), false);
+
+  seen[0] = true;
+  vertices[0].depth = 0;
+
+  for (size_t k = 0; k < queue.size(); ++k) {
+    vertex &v = vertices[queue[k]];
+
+    for (auto i : v)
+      if (!seen[i]) {
+        seen[i] = true;
+        vertices[i].depth = v.depth + 1;
+        queue.push_back(i);
+      }
+  }
+}
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
+#include <algorithm>
 
 #include "types.h"
 
@@ -17,9 +19,13 @@
  */
 struct vertex {
   int id, color, area, marker;
+
+  // Distance (in groups) from the first vertex (upper-left corner)
+  int depth;
   std::vector<int> neighbors;
 
-  vertex(int i, int c, int a) : id(i), color(c), area(a), marker(0) {}
+  vertex(int i, int c, int a) : id(i), color(c), area(a), marker(0),
+      depth(0) {}
 
   ~vertex() {
     neighbors.clear();
@@ -53,6 +59,13 @@ public:
 
   ~Graph();
 
+  // Declared explicitly, the destructor alone disables moving graphs (every
+  // move would be a copy)
+  Graph(const Graph &) = default;
+  Graph(Graph &&) = default;
+  Graph &operator=(const Graph &) = default;
+  Graph &operator=(Graph &&) = default;
+
   /**
    * Adds edge between v-th and u-th vertex
    *
@@ -75,4 +88,35 @@ public:
    * @return vectices[i].
    */
   vertex &operator[](int i);
+
+  /**
+   * Gets number of vertices in the graph.
+   *
+   * @return number of vertices.
+   */
+  int size();
+
+  /**
+   * Computes a hash (FNV-1a) of the graph's structure (colors, areas and
+   * adjacency lists), used to identify previously seen boards.
+   *
+   * @return 64-bit hash of the graph.
+   */
+  uint64_t hash();
+
+  /**
+   * Floods the first vertex (flooded region) with a color, contracting it
+   * and its neighbors of that color into a single vertex (still the first
+   * one). Absorbed vertices are removed and the remaining ones renumbered,
+   * keeping their relative order.
+   *
+   * @param color color used to flood the region.
+   * @return number of absorbed vertices.
+   */
+  int contract(int color);
+
+  /**
+   * Computes depth of every vertex (BFS distance from the first vertex).
+   */
+  void compute_depths();
 };
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#include "local_search.h"
+
+// Initializes local search without a graph.
+LocalSearch::LocalSearch() : c(0) {}
+
+// Initializes local search.
+LocalSearch::LocalSearch(Graph *graph, int c) : flood(graph, c), c(c) {}
+
+// Associates a graph to the local search, reusing allocated memory.
+void LocalSearch::set_graph(Graph *graph, int c) {
+  flood.set_graph(graph, c);
+  this->c = c;
+}
+
+// Checks whether applying moves[from..] to the current state solves the
+// game (state is left unchanged).
+bool LocalSearch::solves(const std::vector<int> &moves, int from) {
+  int applied = 0;
+  for (int i = from; i < int(moves.size()) and !flood.done(); ++i) {
+    flood.apply(moves[i]);
+    applied++;
+  }
+
+  bool ans = flood.done();
+  while (applied--)
+    flood.undo();
+
+  return ans;
+}
+
+// Looks exhaustively for a sequence of movements that, applied to the
+// current state followed by moves[from..], solves the game.
+bool LocalSearch::solve_window(const std::vector<int> &moves, int from,
+    int depth, std::vector<int> &window) {
+  if (depth == 0)
+    return clk::now() < deadline and solves(moves, from);
+
+  // Only colors adjacent to the flooded region change the board
+  for (int color = 1; color <= c; ++color) {
+    if (!flood.available(color))
+      continue;
+
+    flood.apply(color);
+    window.push_back(color);
+
+    bool found = solve_window(moves, from, depth - 1, window);
+    flood.undo();
+
+    if (found)
+      return true;
+
+    window.pop_back();
+  }
+
+  return false;
+}
+
+// Goes through the solution once, replacing every window of movements that
+// can be solved with one movement less.
+bool LocalSearch::improve(std::vector<int> &moves, int size) {
+  bool improved = false;
+  flood.reset();
+
+  // Current state is always the one after moves[0..i-1]
+  for (int i = 0; i + size <= int(moves.size()) and clk::now() < deadline; ) {
+    std::vector<int> window;
+
+    if (solve_window(moves, i + size, size - 1, window)) {
+      moves.erase(moves.begin() + i, moves.begin() + i + size);
+      moves.insert(moves.begin() + i, window.begin(), window.end());
+      improved = true;
+      continue;
+    }
+
+    flood.apply(moves[i++]);
+  }
+
+  return improved;
+}
+
+// Goes through the solution once, swapping each pair of adjacent movements
+// and looking for a later movement that can be dropped after the swap.
+bool LocalSearch::swap_and_drop(std::vector<int> &moves) {
+  flood.reset();
+
+  // Current state is always the one after moves[0..i-1]
+  for (int i = 0; i + 2 < int(moves.size()) and clk::now() < deadline; ++i) {
+    if (moves[i] != moves[i + 1]) {
+      flood.apply(moves[i + 1]);
+      flood.apply(moves[i]);
+      int applied = 2;
+
+      // Try dropping moves[j], with moves[i + 2..j - 1] already applied
+      for (int j = i + 2; j < int(moves.size()) and clk::now() < deadline;
+          ++j) {
+        if (solves(moves, j + 1)) {
+          while (applied--)
+            flood.undo();
+
+          std::swap(moves[i], moves[i + 1]);
+          moves.erase(moves.begin() + j);
+          return true;
+        }
+
+        flood.apply(moves[j]);
+        applied++;
+      }
+
+      while (applied--)
+        flood.undo();
+    }
+
+    flood.apply(moves[i]);
+  }
+
+  return false;
+}
+
+// Shortens a solution until no edit improves it or time is over.
+std::vector<int> LocalSearch::run(std::vector<int> moves, double seconds,
+    int k) {
+  deadline = clk::now() + std::chrono::microseconds(int64_t(seconds * 1e6));
+
+  // Larger windows are much more expensive, so they are only tried when
+  // smaller ones (starting by dropping single movements) stop improving;
+  // swaps are tried last
+  int size = 1;
+  while (clk::now() < deadline) {
+    if (size <= k) {
+      if (improve(moves, size))
+        size = 1;
+      else
+        size++;
+
+    } else if (swap_and_drop(moves)) {
+      size = 1;
+
+    } else {
+      break;
+    }
+  }
+
+  return moves;
+}
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "types.h"
+#include "graph.h"
+#include "flood.h"
+
+/**
+ * Shortens a solution found by the search by editing it locally: replacing
+ * windows of k movements by k - 1 movements (k = 1 drops a movement), and
+ * swapping adjacent movements when that allows dropping a later one.
+ */
+class LocalSearch {
+
+private:
+  Flood flood;
+  int c;
+
+  clk::time_point deadline;
+
+  /**
+   * Checks whether applying moves[from..] to the current state solves the
+   * game (state is left unchanged).
+   *
+   * @param moves sequence of movements.
+   * @param from index of the first movement to be applied.
+   * @return whether the game is solved.
+   */
+  bool solves(const std::vector<int> &moves, int from);
+
+  /**
+   * Looks exhaustively for a sequence of movements that, applied to the
+   * current state followed by moves[from..], solves the game.
+   *
+   * @param moves sequence of movements.
+   * @param from index of the first movement after the window.
+   * @param depth number of movements left to choose.
+   * @param window filled with the chosen movements.
+   * @return whether a sequence was found.
+   */
+  bool solve_window(const std::vector<int> &moves, int from, int depth,
+      std::vector<int> &window);
+
+  /**
+   * Goes through the solution once, replacing every window of movements that
+   * can be solved with one movement less.
+   *
+   * @param moves sequence of movements that solves the game.
+   * @param size size of the windows.
+   * @return whether the solution was shortened.
+   */
+  bool improve(std::vector<int> &moves, int size);
+
+  /**
+   * Goes through the solution once, swapping each pair of adjacent movements
+   * and looking for a later movement that can be dropped after the swap.
+   *
+   * @param moves sequence of movements that solves the game.
+   * @return whether the solution was shortened.
+   */
+  bool swap_and_drop(std::vector<int> &moves);
+
+public:
+  /**
+   * Initializes local search without a graph (set_graph must be called
+   * before it is used).
+   */
+  LocalSearch();
+
+  /**
+   * Initializes local search.
+   *
+   * @param graph graph of the board.
+   * @param c number of colors.
+   */
+  LocalSearch(Graph *graph, int c);
+
+  /**
+   * Associates a graph to the local search, reusing allocated memory (used
+   * when the same object shortens solutions of several boards).
+   *
+   * @param graph graph of the board.
+   * @param c number of colors.
+   */
+  void set_graph(Graph *graph, int c);
+
+  /**
+   * Shortens a solution until no edit improves it or time is over.
+   *
+   * @param moves sequence of movements that solves the game.
+   * @param seconds time budget.
+   * @param k maximum size of the windows solved exhaustively.
+   * @return shortened sequence of movements.
+   */
+  std::vector<int> run(std::vector<int> moves, double seconds, int k);
+};
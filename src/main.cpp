@@ -7,8 +7,16 @@
  */
 
 #include <vector>
+#include <string>
+#include <thread>
+#include <cstdlib>
 #include <iostream>
+#include <unistd.h>
 
+#include "cache.h"
+#include "server.h"
+#include "exact.h"
+#include "local_search.h"
 #include "builder.h"
 #include "board.h"
 #include "types.h"
@@ -18,40 +26,214 @@ class Solver {
 
 private:
   int n, m, c;
+  int num_threads, play_iter;
+  double widen_k;
+  Policy policy;
+  std::string cache_path;
+
+  /**
+   * Searches for a solution, either all at once or one move at a time.
+   *
+   * @param board board with its graph already set.
+   * @param graph graph of the board.
+   * @param incumbent known solution used to warm start the search.
+   * @return sequence of movements that solves the board.
+   */
+  std::vector<int> search(Board &board, Graph &graph,
+      std::vector<int> incumbent) {
+
+    // Small boards are solved exactly if it costs about as much as the Monte
+    // Carlo Tree Search, otherwise MCTS is used
+    if (play_iter == 0 and graph.size() <= Exact::MAX_GROUPS) {
+      std::vector<int> solution;
+      Exact exact(&graph, c, num_threads);
+
+      if (exact.run(int64_t(Exact::NODES_PER_ITERATION) * 35000, solution))
+        return solution;
+    }
+
+    MonteCarloTS mcts(123, &board);
+    mcts.set_policy(policy);
+    mcts.set_widening(widen_k, 0.5);
+
+    // Run Monte Carlo Search Tree
+    if (play_iter == 0)
+      return mcts.run(35000, 4, 53, incumbent);
+
+    // Play best move and search again on the contracted graph, using the
+    // rest of the best sequence as incumbent
+    std::vector<int> moves;
+    while (board.num_groups() > 1) {
+      incumbent = mcts.run(play_iter, 4, 53, incumbent);
+
+      moves.push_back(incumbent[0]);
+      board.commit_move(incumbent[0]);
+      incumbent.erase(incumbent.begin());
+    }
+
+    return moves;
+  }
+
+  /**
+   * Shortens solution found by the search with a quick local search.
+   *
+   * @param graph graph of the board (before any movement).
+   * @param solution sequence of movements that solves the board.
+   * @return shortened solution.
+   */
+  std::vector<int> shorten(Graph &graph, const std::vector<int> &solution) {
+    LocalSearch local(&graph, c);
+    return local.run(solution, 0.1, 3);
+  }
 
 public:
-  void read_input() {
-    std::cin >> n >> m >> c;
+  /**
+   * Initializes solver.
+   *
+   * @param cache_path file used to persist solutions (empty disables cache).
+   * @param num_threads number of threads used to build the graph.
+   * @param play_iter iterations per move when playing move by move (0 means
+   * a single search for the whole game).
+   * @param policy policy used in the rollouts.
+   * @param widen_k progressive widening constant (0 disables it).
+   */
+  Solver(std::string cache_path, int num_threads, int play_iter,
+      Policy policy, double widen_k) : num_threads(num_threads),
+      play_iter(play_iter), widen_k(widen_k), policy(policy),
+      cache_path(cache_path) {}
+
+  /**
+   * Reads board size and number of colors.
+   *
+   * @return whether they were read and are valid.
+   */
+  bool read_input() {
+    return bool(std::cin >> n >> m >> c) and n > 0 and m > 0 and c > 0 and
+        c <= Board::MAX_COLORS;
   }
 
-  void run() {
-    read_input();
+  /**
+   * Reads the board and prints its solution.
+   *
+   * @return whether the input was valid.
+   */
+  bool run() {
+    if (!read_input())
+      return false;
 
     // Construct board (false = 4 neighbors, true = 8 neighbors)
     Board board(n, m, c, true);
-    board.read_input();
+    if (!board.read_input())
+      return false;
 
     // Build graph of groups from board
-    Builder builder(&board);
+    Builder builder(&board, true, num_threads);
     Graph graph = builder.build_graph();
     board.set_graph(graph);
 
-    // Run Monte Carlo Search Tree
-    MonteCarloTS mcts(123, &board);
-    std::vector<int> solution = mcts.run(35000, 4, 53);
+    std::vector<int> solution;
+
+    if (cache_path.empty()) {
+      solution = search(board, graph, std::vector<int>());
+      solution = shorten(graph, solution);
+
+    } else {
+      Cache cache(cache_path);
+      uint64_t key = graph.hash();
+
+      // Known board, no search needed
+      if (!cache.find(key, &graph, c, solution)) {
+        std::vector<int> incumbent;
+        cache.find_similar(n, m, c, incumbent);
+
+        // Search starting from similar board's solution
+        solution = search(board, graph, incumbent);
+        solution = shorten(graph, solution);
+        cache.insert(key, n, m, c, solution);
+      }
+    }
 
     // Print solution
     std::cout << solution.size() << std::endl;
     for (auto i : solution)
       std::cout << i << " ";
     std::cout << std::endl;
+
+    return true;
   }
 };
 
 
-int main() {
-  Solver solver;
-  solver.run();
+// Prints usage message, returns the exit code for bad arguments.
+int usage(const char *name) {
+  std::cerr << "usage: " << name << " [-c cache_file] [-s] [-j threads]"
+            << " [-p iterations] [-r weighted|lookahead|farthest] [-w k]"
+            << std::endl;
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  // Large boards have millions of tiles to read
+  std::ios::sync_with_stdio(false);
+
+  std::string cache_path;
+  bool server_mode = false;
+  int play_iter = 0;
+  Policy policy = Policy::weighted;
+  double widen_k = 0;
+  int num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  int opt;
+  while ((opt = getopt(argc, argv, "c:sj:p:r:w:")) != -1) {
+    switch (opt) {
+      case 'c':
+        cache_path = optarg;
+        break;
+      case 's':
+        server_mode = true;
+        break;
+      case 'j':
+        num_threads = std::max(1, atoi(optarg));
+        break;
+      case 'p':
+        play_iter = std::max(1, atoi(optarg));
+        break;
+      case 'r':
+        if (std::string(optarg) == "weighted")
+          policy = Policy::weighted;
+        else if (std::string(optarg) == "lookahead")
+          policy = Policy::lookahead;
+        else if (std::string(optarg) == "farthest")
+          policy = Policy::farthest;
+        else
+          return usage(argv[0]);
+        break;
+      case 'w':
+        widen_k = atof(optarg);
+        break;
+      default:
+        return usage(argv[0]);
+    }
+  }
+
+  // Long-lived mode, solves every board received on stdin (each board is
+  // searched all at once, playing move by move is not supported)
+  if (server_mode) {
+    if (play_iter > 0)
+      return usage(argv[0]);
+
+    Server server(num_threads, cache_path, policy, widen_k);
+    server.run(std::cin, std::cout);
+    return 0;
+  }
+
+  Solver solver(cache_path, num_threads, play_iter, policy, widen_k);
+  if (!solver.run()) {
+    std::cerr << "invalid board: size must be positive, with 1 to "
+              << Board::MAX_COLORS << " colors and tiles between 1 and c"
+              << std::endl;
+    return 1;
+  }
 
   return 0;
 }
@@ -8,7 +8,9 @@
 
 #include "monte_carlo.h"
 
-State::State(Board *board) : board(board) {
+// Initializes state.
+State::State(Board *board, std::mt19937 *rng, Policy policy) :
+    board(board), rng(rng), policy(policy) {
   reset();
 }
 
@@ -19,12 +21,43 @@ void State::apply_move(int color) {
   actions = board->apply_color(color);
 }
 
+// Gets best action according to the rollout policy's score.
+int State::greedy_move() {
+  int move = 0;
+  long long best = -1;
+
+  for (auto i : actions) {
+    long long score;
+
+    // Farthest layer first, ties broken by area
+    if (policy == Policy::farthest)
+      score = (long long) board->reach(i.second) * board->n * board->m +
+        i.first;
+    else
+      score = board->lookahead(i.second);
+
+    if (score > best) {
+      best = score;
+      move = i.second;
+    }
+  }
+
+  return move;
+}
+
 // Applies random movements until board is complete.
 void State::rollout() {
 
   // Apply random movements until board is complete
   while (actions.size() > 0) {
 
+    // Guided policies play their best movement half of the time, the other
+    // half keeps rollouts diverse
+    if (policy != Policy::weighted and (*rng)() % 2) {
+      apply_move(greedy_move());
+      continue;
+    }
+
     // Generate random movement with greater probability to colors that
     // yields a greater area
     int sum = 0;
@@ -32,7 +65,7 @@ void State::rollout() {
       sum += i.first;
 
     int move = 0;
-    int move_cnt = rand() % sum;
+    int move_cnt = (*rng)() % sum;
 
     for (auto i : actions) {
       move_cnt -= i.first;
@@ -67,24 +100,29 @@ double State::get_result(double bound) {
 
 // Creates new node and builds list of untried moves.
 Node::Node(tuple2 move, const State &state, Node *parent, double C, double D) {
+  init(move, state, parent, C, D);
+}
+
+// Resets node as if it was just created (keeps allocated memory).
+void Node::init(tuple2 move, const State &state, Node *parent, double C,
+    double D) {
   this->move = move;
   this->parent = parent;
   this->points = this->visits = this->sq_points = 0.0;
   this->C = C;
   this->D = D;
 
+  this->children.clear();
   this->remaining_actions = state.actions;
 }
 
 // Creates new node, adds it to children vector and returns it.
-Node *Node::add_child(int move_pos, State &state) {
-  Node *n = new Node(remaining_actions[move_pos], state, this, C, D);
-
-  // Fast vector element erasing, since order does not matter
-  swap(remaining_actions[move_pos],
-       remaining_actions[remaining_actions.size() - 1]);
+Node *Node::add_child(int move_pos, State &state, NodePool *pool) {
+  Node *n = pool->get(remaining_actions[move_pos], state, this, C, D);
 
-  remaining_actions.erase(--(remaining_actions.end()));
+  // Keep order, untried moves are sorted by prior (area yielded). Usually
+  // the last one is taken, so erasing is cheap
+  remaining_actions.erase(remaining_actions.begin() + move_pos);
 
   children.push_back(n);
   return n;
@@ -105,6 +143,15 @@ double Node::calc_uct(const Node *child) {
   return fi + se + th;
 }
 
+// Checks whether a new child can be added (progressive widening).
+bool Node::expandable(double k, double alpha) {
+  if (remaining_actions.size() == 0)
+    return false;
+
+  // Number of children grows with the number of visits
+  return k <= 0 or children.size() < std::max(1.0, k * pow(visits, alpha));
+}
+
 // Gets child with the greatest UCT value.
 Node *Node::uct_child() {
   return *(max_element(children.begin(), children.end(),
@@ -124,38 +171,142 @@ void Node::update(double result) {
 }
 
 
+NodePool::NodePool() : used(0) {}
+
+NodePool::~NodePool() {
+  for (auto i : nodes)
+    delete i;
+}
+
+// Gets an initialized node from the pool (allocating it if necessary).
+Node *NodePool::get(tuple2 move, const State &state, Node *parent, double C,
+    double D) {
+  if (used == nodes.size()) {
+    nodes.push_back(new Node(move, state, parent, C, D));
+    return nodes[used++];
+  }
+
+  nodes[used]->init(move, state, parent, C, D);
+  return nodes[used++];
+}
+
+// Releases every node back to the pool.
+void NodePool::clear() {
+  used = 0;
+}
+
+
 // Specifies random seed and associates board to be used by state.
-MonteCarloTS::MonteCarloTS(int seed, Board *board) : board(board) {
-  srand(seed);
+MonteCarloTS::MonteCarloTS(int seed, Board *board) : board(board), rng(seed) {
+  policy = Policy::weighted;
+  // Progressive widening disabled by default
+  widen_k = 0;
+  widen_alpha = 0.5;
+  has_deadline = false;
+}
+
+// Resets random seed.
+void MonteCarloTS::seed(int seed) {
+  rng.seed(seed);
+}
+
+// Changes policy used to choose movements in rollouts.
+void MonteCarloTS::set_policy(Policy policy) {
+  this->policy = policy;
+}
+
+// Changes progressive widening parameters.
+void MonteCarloTS::set_widening(double k, double alpha) {
+  widen_k = k;
+  widen_alpha = alpha;
+}
+
+// Limits the time of the next searches.
+void MonteCarloTS::set_deadline(clk::time_point deadline) {
+  this->deadline = deadline;
+  has_deadline = true;
+}
+
+// Removes time limit (only number of iterations is used).
+void MonteCarloTS::clear_deadline() {
+  has_deadline = false;
+}
+
+// Plays a known sequence of movements (incumbent) from the root, creating
+// the corresponding path in the tree.
+std::vector<int> MonteCarloTS::warm_start(Node *root, State &state,
+    const std::vector<int> &incumbent) {
+  Node *node = root;
+
+  for (auto move : incumbent) {
+    auto it = std::find_if(node->remaining_actions.begin(),
+        node->remaining_actions.end(),
+        [move](const tuple2 &a) { return a.second == move; });
+
+    // Movement does not change the board (or is not valid), skip it
+    if (it == node->remaining_actions.end())
+      continue;
+
+    state.apply_move(move);
+    node = node->add_child(it - node->remaining_actions.begin(), state, &pool);
+  }
+
+  // Complete sequence in case incumbent came from a different board
+  state.rollout();
+
+  while (node != nullptr) {
+    node->update(state.get_result(moves_upper));
+    node = node->parent;
+  }
+
+  std::vector<int> played = state.backup;
+  state.reset();
+
+  return played;
+}
+
+// Applies Monte Carlo Tree Search.
+std::vector<int> MonteCarloTS::run(int num_iter, double C, double D,
+    const std::vector<int> &incumbent) {
 
   // Calculate maximum number of movements needed (i.e. upper bound) - Clifford et al.
   int N = std::max(board->n, board->m);
   this->moves_upper = (2*N + sqrt(2 * board->c) * N + board->c);
-}
 
-// Applies Monte Carlo Tree Search.
-std::vector<int> MonteCarloTS::run(int num_iter, double C, double D) {
-  State state(board);
+  State state(board, &rng, policy);
+
+  // Nodes of previous searches are reused
+  pool.clear();
 
   std::vector<int> best_backup;
-  Node *root = new Node(tuple2(-1, -1), state, nullptr, C, D);
+  Node *root = pool.get(tuple2(-1, -1), state, nullptr, C, D);
+
+  // Seed tree and best solution with the known one
+  if (incumbent.size() > 0)
+    best_backup = warm_start(root, state, incumbent);
 
   for (int iter = 0; iter < num_iter; ++iter) {
     Node *node = root;
 
+    // Check deadline every few iterations only, clock is not free
+    if (has_deadline and iter % 64 == 0 and best_backup.size() > 0 and
+        clk::now() >= deadline)
+      break;
+
     // Select
-    while (node->remaining_actions.size() == 0 and node->children.size() != 0) {
+    while (!node->expandable(widen_k, widen_alpha) and
+        node->children.size() != 0) {
       node = node->uct_child();
       state.apply_move(node->move.second);
     }
 
-    // Expand
-    if (node->remaining_actions.size() != 0) {
-      int move_pos = rand() % node->remaining_actions.size();
+    // Expand, untried move with greatest prior first
+    if (node->expandable(widen_k, widen_alpha)) {
+      int move_pos = node->remaining_actions.size() - 1;
       int move = node->remaining_actions[move_pos].second;
 
       state.apply_move(move);
-      node = node->add_child(move_pos, state);
+      node = node->add_child(move_pos, state, &pool);
     }
 
     // Rollout
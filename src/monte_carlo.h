@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cmath>
+#include <random>
 #include <utility>
 #include <algorithm>
 
@@ -17,17 +18,50 @@
 #include "builder.h"
 #include "types.h"
 
+/**
+ * Policies used to choose movements in the rollout phase.
+ */
+enum class Policy {
+  // Random, proportional to the area yielded by the movement
+  weighted,
+
+  // Half of the movements maximize the area yielded by the movement followed
+  // by the best second movement, the others are chosen like weighted
+  lookahead,
+
+  // Half of the movements reach the vertex farthest from the corner (in
+  // groups), the others are chosen like weighted
+  farthest
+};
+
+
 class State {
 
 private:
   Board *board;
+  std::mt19937 *rng;
+  Policy policy;
   int num_moves;
 
+  /**
+   * Gets best action according to the rollout policy's score.
+   *
+   * @return best movement (color).
+   */
+  int greedy_move();
+
 public:
   std::vector<int> backup;
   std::vector<tuple2> actions;
 
-  State(Board *board);
+  /**
+   * Initializes state.
+   *
+   * @param board board used in the puzzle.
+   * @param rng random number generator used by rollouts.
+   * @param policy policy used to choose movements in rollouts.
+   */
+  State(Board *board, std::mt19937 *rng, Policy policy = Policy::weighted);
 
   /**
    * Applies movement.
@@ -56,6 +90,8 @@ public:
 };
 
 
+class NodePool;
+
 class Node {
 
 private:
@@ -87,15 +123,35 @@ public:
    */
   Node(tuple2 move, const State &state, Node *parent, double C, double D);
 
+  /**
+   * Resets node as if it was just created (keeps allocated memory).
+   *
+   * @param move movement that generated this node.
+   * @param state state of the game when node was created.
+   * @param parent parent node.
+   * @param (C, D) constants for UCT.
+   */
+  void init(tuple2 move, const State &state, Node *parent, double C, double D);
+
   /**
    * Creates new node, adds it to children vector and returns it.
    *
    * @param move_pos index of remaining_actions indicating movement that
    * generated new child.
    * @param state state of the game when child node was created.
+   * @param pool pool where the child node is allocated.
    * @return newly created child node.
    */
-  Node *add_child(int move_pos, State &state);
+  Node *add_child(int move_pos, State &state, NodePool *pool);
+
+  /**
+   * Checks whether a new child can be added: there are untried moves and the
+   * number of children is below k * visits^alpha (progressive widening).
+   *
+   * @param (k, alpha) progressive widening constants (k <= 0 disables it).
+   * @return whether node can be expanded.
+   */
+  bool expandable(double k, double alpha);
 
   /**
    * Gets child with the greatest UCT value.
@@ -113,12 +169,69 @@ public:
 };
 
 
+/**
+ * Arena of nodes reused between searches, avoiding allocations once the pool
+ * has grown to the size of the largest tree.
+ */
+class NodePool {
+
+private:
+  std::vector<Node*> nodes;
+  size_t used;
+
+public:
+  NodePool();
+
+  ~NodePool();
+
+  /**
+   * Gets an initialized node from the pool (allocating it if necessary).
+   *
+   * @param move movement that generated this node.
+   * @param state state of the game when node was created.
+   * @param parent parent node.
+   * @param (C, D) constants for UCT.
+   * @return initialized node.
+   */
+  Node *get(tuple2 move, const State &state, Node *parent, double C, double D);
+
+  /**
+   * Releases every node back to the pool.
+   */
+  void clear();
+};
+
+
 class MonteCarloTS {
 
 private:
   Board *board;
   double moves_upper;
 
+  NodePool pool;
+  std::mt19937 rng;
+  Policy policy;
+
+  // Progressive widening constants
+  double widen_k, widen_alpha;
+
+  bool has_deadline;
+  clk::time_point deadline;
+
+  /**
+   * Plays a known sequence of movements (incumbent) from the root, creating
+   * the corresponding path in the tree. Movements that are not available in
+   * the current state are skipped and the sequence is completed by a rollout,
+   * so solutions from similar boards can also be used.
+   *
+   * @param root root node of the tree.
+   * @param state state of the game (at the root).
+   * @param incumbent known sequence of movements.
+   * @return sequence of movements actually played.
+   */
+  std::vector<int> warm_start(Node *root, State &state,
+      const std::vector<int> &incumbent);
+
 public:
   /**
    * Specifies random seed and associates board to be used by state.
@@ -128,12 +241,50 @@ public:
    */
   MonteCarloTS(int seed, Board *board);
 
+  /**
+   * Resets random seed (e.g. to get the same results for the same board when
+   * the instance is reused).
+   *
+   * @param seed random seed.
+   */
+  void seed(int seed);
+
+  /**
+   * Changes policy used to choose movements in rollouts.
+   *
+   * @param policy rollout policy.
+   */
+  void set_policy(Policy policy);
+
+  /**
+   * Changes progressive widening parameters: a node can only have
+   * k * visits^alpha children, tried in order of prior (area yielded).
+   *
+   * @param (k, alpha) progressive widening constants (k <= 0 disables it).
+   */
+  void set_widening(double k, double alpha);
+
+  /**
+   * Limits the time of the next searches; run stops at the deadline even if
+   * not every iteration was made.
+   *
+   * @param deadline time point when search must stop.
+   */
+  void set_deadline(clk::time_point deadline);
+
+  /**
+   * Removes time limit (only number of iterations is used).
+   */
+  void clear_deadline();
+
   /**
    * Applies Monte Carlo Tree Search.
    *
    * @param num_iter number of iterations.
    * @param (C, D) constants for UCT.
+   * @param incumbent known solution used to warm start the search (optional).
    * @return result (i.e. sequence of movements to solve game).
    */
-  std::vector<int> run(int num_iter, double C, double D);
+  std::vector<int> run(int num_iter, double C, double D,
+      const std::vector<int> &incumbent = std::vector<int>());
 };
@@ -0,0 +1,260 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#include "server.h"
+
+// Initializes server and its workers' contexts.
+Server::Server(int num_workers, std::string cache_path, Policy policy,
+    double widen_k) {
+  done = false;
+
+  if (!cache_path.empty())
+    cache.reset(new Cache(cache_path));
+
+  for (int i = 0; i < num_workers; ++i) {
+    contexts.push_back(std::unique_ptr<context>(new context()));
+    contexts.back()->mcts.set_policy(policy);
+    contexts.back()->mcts.set_widening(widen_k, 0.5);
+  }
+}
+
+// Largest board accepted, in tiles (about 9 bytes per tile per worker)
+static const int64_t MAX_TILES = 1 << 26;
+
+// Largest board whose tiles are kept by a worker for the next request, the
+// memory of larger ones is freed once their graph is built
+static const int64_t KEEP_TILES = 1 << 20;
+
+// Discards input up to the next blank line (or the end of the input).
+void Server::skip_request(std::istream &in) {
+  std::string line;
+  std::getline(in, line);
+
+  while (std::getline(in, line) and
+      line.find_first_not_of(" \t\r") != std::string::npos);
+}
+
+// Reads a request from the input stream.
+bool Server::read_request(std::istream &in, request &req) {
+  int deadline_ms;
+  req.error.clear();
+
+  if (!(in >> req.id)) {
+    if (in.eof())
+      return false;
+
+    // No id to answer with
+    in.clear();
+    req.id = -1;
+    req.error = "malformed request";
+    skip_request(in);
+    return true;
+  }
+
+  // Input ending in the middle of a request is still answered (its id is
+  // known), the next read finds the end of the input
+  if (!(in >> deadline_ms >> req.n >> req.m >> req.c)) {
+    if (in.eof()) {
+      req.error = "truncated request";
+      return true;
+    }
+
+    in.clear();
+    req.error = "malformed request";
+    skip_request(in);
+    return true;
+  }
+
+  // Without valid dimensions there is no way to know where the board ends
+  if (req.n <= 0 or req.m <= 0 or int64_t(req.n) * req.m > MAX_TILES) {
+    req.error = "invalid board size";
+    skip_request(in);
+    return true;
+  }
+
+  if (req.c <= 0 or req.c > Board::MAX_COLORS)
+    req.error = "invalid number of colors";
+
+  // Deadline counts from the moment the request arrives
+  req.has_deadline = deadline_ms > 0;
+  req.deadline = clk::now() + std::chrono::milliseconds(deadline_ms);
+
+  // Every tile is read even if one is invalid, so the next request starts
+  // at the right place
+  req.tiles.resize(req.n * req.m);
+  for (auto &i : req.tiles) {
+    if (!(in >> i)) {
+      if (in.eof()) {
+        req.error = "truncated request";
+        return true;
+      }
+
+      // Out of range numbers are consumed (and saturated), anything else is
+      // skipped as a whole token
+      std::string token;
+      in.clear();
+      if (i != INT_MAX and i != INT_MIN)
+        in >> token;
+      req.error = "malformed tile";
+
+    } else if (req.error.empty() and (i < 1 or i > req.c)) {
+      req.error = "invalid color";
+    }
+  }
+
+  return true;
+}
+
+// Solves a single request using the worker's context.
+std::vector<int> Server::solve(context *ctx, const request &req) {
+  ctx->board.resize(req.n, req.m, req.c);
+  for (int i = 0; i < req.n; ++i)
+    for (int j = 0; j < req.m; ++j)
+      ctx->board[i][j] = req.tiles[i * req.m + j];
+
+  Graph graph = ctx->builder.build_graph();
+  ctx->board.set_graph(graph);
+
+  if (int64_t(req.n) * req.m > KEEP_TILES)
+    ctx->builder.release();
+
+  std::vector<int> solution, incumbent;
+  uint64_t key = graph.hash();
+
+  if (cache) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (cache->find(key, &graph, req.c, solution))
+      return solution;
+
+    cache->find_similar(req.n, req.m, req.c, incumbent);
+  }
+
+  // Small boards are solved exactly if possible, with the same node budget
+  // as the single board solver (and at most half of the time left)
+  if (graph.size() <= Exact::MAX_GROUPS) {
+    ctx->exact.set_graph(&graph, req.c);
+
+    if (req.has_deadline)
+      ctx->exact.set_deadline(clk::now() + (req.deadline - clk::now()) / 2);
+    else
+      ctx->exact.clear_deadline();
+
+    if (ctx->exact.run(int64_t(Exact::NODES_PER_ITERATION) * 35000,
+          solution)) {
+      if (cache) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cache->insert(key, req.n, req.m, req.c, solution);
+      }
+
+      return solution;
+    }
+  }
+
+  // Same parameters as the single board solver, reseeded so the answer does
+  // not depend on which worker got the request. The exact search and Monte
+  // Carlo are bounded by nodes and iterations, so the answer only depends on
+  // timing when the request's deadline or the local search's time budget
+  // cut them short
+  ctx->mcts.seed(123);
+  if (req.has_deadline)
+    ctx->mcts.set_deadline(req.deadline);
+  else
+    ctx->mcts.clear_deadline();
+
+  solution = ctx->mcts.run(35000, 4, 53, incumbent);
+
+  // Shorten solution with whatever is left of the time, up to 0.1s
+  double budget = 0.1;
+  if (req.has_deadline)
+    budget = std::min(budget,
+        std::chrono::duration<double>(req.deadline - clk::now()).count());
+
+  if (budget > 0) {
+    ctx->local.set_graph(&graph, req.c);
+    solution = ctx->local.run(solution, budget, 3);
+  }
+
+  if (cache) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache->insert(key, req.n, req.m, req.c, solution);
+  }
+
+  return solution;
+}
+
+// Worker loop, solves requests until the input ends and the queue is empty.
+void Server::work(context *ctx) {
+  std::ostream &out = *output;
+
+  while (true) {
+    request req;
+
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_cv.wait(lock, [this] { return done or !requests.empty(); });
+
+      if (requests.empty())
+        return;
+
+      req = std::move(requests.front());
+      requests.pop();
+    }
+
+    // Invalid requests are answered with an error, the server keeps running
+    std::vector<int> solution;
+    if (req.error.empty()) {
+      try {
+        solution = solve(ctx, req);
+      } catch (const std::bad_alloc &) {
+        req.error = "out of memory";
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(output_mutex);
+    if (!req.error.empty()) {
+      out << req.id << " error " << req.error << std::endl;
+      continue;
+    }
+
+    out << req.id << " " << solution.size();
+    for (auto i : solution)
+      out << " " << i;
+    out << std::endl;
+  }
+}
+
+// Reads requests from the input and writes solutions to the output until
+// the input ends.
+void Server::run(std::istream &in, std::ostream &out) {
+  output = &out;
+  done = false;
+
+  // std::cin flushes std::cout before every read, which would race with the
+  // workers writing answers (each answer is flushed anyway)
+  in.tie(nullptr);
+
+  for (auto &i : contexts)
+    workers.push_back(std::thread(&Server::work, this, i.get()));
+
+  request req;
+  while (read_request(in, req)) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    requests.push(std::move(req));
+    queue_cv.notify_one();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    done = true;
+  }
+  queue_cv.notify_all();
+
+  for (auto &i : workers)
+    i.join();
+  workers.clear();
+}
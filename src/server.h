@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2018 Bruno Freitas Tissei
+ *
+ * Distributed under the MIT software licenser. For the full copyright and
+ * license information, please view the LICENSE file distributed with this
+ * source code. 
+ */
+
+#pragma once
+
+#include <new>
+#include <queue>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <condition_variable>
+
+#include "types.h"
+#include "board.h"
+#include "cache.h"
+#include "exact.h"
+#include "builder.h"
+#include "monte_carlo.h"
+#include "local_search.h"
+
+/**
+ * Board received by the server, waiting to be solved.
+ */
+struct request {
+  int id, n, m, c;
+  std::vector<int> tiles;
+
+  bool has_deadline;
+  clk::time_point deadline;
+
+  // Why the request can't be solved (empty if it is valid)
+  std::string error;
+};
+
+/**
+ * Everything a worker needs to solve a board; kept alive between requests so
+ * memory (board, tree nodes, transposition tables) is allocated only once.
+ * Tiles of boards larger than 2^20 tiles are not kept.
+ */
+struct context {
+  Board board;
+  Builder builder;
+  MonteCarloTS mcts;
+  Exact exact;
+  LocalSearch local;
+
+  context() : board(1, 1, 1, true), builder(&board, false), mcts(123, &board) {}
+};
+
+
+class Server {
+
+private:
+  bool done;
+
+  std::unique_ptr<Cache> cache;
+  std::vector<std::unique_ptr<context>> contexts;
+  std::vector<std::thread> workers;
+  std::queue<request> requests;
+
+  std::ostream *output;
+  std::mutex queue_mutex, output_mutex, cache_mutex;
+  std::condition_variable queue_cv;
+
+  /**
+   * Discards input up to the next blank line, used to find the next request
+   * after a malformed one.
+   *
+   * @param in stream where requests are read from.
+   */
+  void skip_request(std::istream &in);
+
+  /**
+   * Reads a request from the input stream. Malformed or invalid requests are
+   * still read, with req.error describing the problem.
+   *
+   * @param in stream where requests are read from.
+   * @param req filled with the read request.
+   * @return whether a request was read (false at the end of the stream,
+   * unless the stream ends in the middle of a request).
+   */
+  bool read_request(std::istream &in, request &req);
+
+  /**
+   * Solves a single request using the worker's context.
+   *
+   * @param ctx worker's context.
+   * @param req request to be solved.
+   * @return sequence of movements that solves the board.
+   */
+  std::vector<int> solve(context *ctx, const request &req);
+
+  /**
+   * Worker loop, solves requests until the input ends and the queue is empty.
+   *
+   * @param ctx worker's context.
+   */
+  void work(context *ctx);
+
+public:
+  /**
+   * Initializes server and its workers' contexts.
+   *
+   * @param num_workers number of worker threads.
+   * @param cache_path file used to persist solutions (empty disables cache).
+   * @param policy policy used in the rollouts.
+   * @param widen_k progressive widening constant (0 disables it).
+   */
+  Server(int num_workers, std::string cache_path, Policy policy,
+      double widen_k);
+
+  /**
+   * Reads requests from the input and writes solutions to the output until
+   * the input ends.
+   *
+   * Each request is a line "id deadline_ms" (0 means no deadline, measured
+   * from the moment the request is read) followed by the board in the same
+   * format used by the solver. Each answer is a line "id size moves...",
+   * or "id error message" for invalid requests; answers may be given out of
+   * order. If a request is so malformed that the board can't be skipped,
+   * the input is discarded up to the next blank line.
+   *
+   * @param in stream where requests are read from.
+   * @param out stream where solutions are written to.
+   */
+  void run(std::istream &in, std::ostream &out);
+};
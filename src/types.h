@@ -16,3 +16,5 @@ template <class T>
 using matrix = std::vector<std::vector<T>>;
 
 using tuple2 = std::pair<int,int>;
+
+using clk = std::chrono::steady_clock;